@@ -3,18 +3,137 @@ Arquivo: main_principal.c
 Autor: Thiago Yukio Horita Pacheco e Larissa de Sousa Gouvea
 Função do arquivo: Software requisitado, em uma atividade, para um fábrica de automóveis
 Criado em 19 de setembro de 2024
-Modificado em 19 de setembro de 2024
-
+Modificado em 19 de outubro de 2026
+
+As tarefas são distribuídas entre os dois núcleos por um particionamento
+(bin-packing) sobre a utilização de cada uma: as tarefas de tempo real
+crítico ficam isoladas em um núcleo e display/estatísticas no outro.
+
+Build para o host (Linux), sem o ESP-IDF:
+    gcc -O2 -o main_principal main_principal.c -lpthread
+    sudo ./main_principal   (SCHED_FIFO exige privilégio; sem ele só a afinidade é aplicada)
+
+Benchmark do jitter da injeção: com -DMEDIR_JITTER=1 o display fecha uma
+janela por segundo e, a cada BENCHMARK_JANELAS janelas, imprime uma linha
+"Benchmark jitter injeção" com o período médio e a mediana, o p99 e o
+máximo do jitter por janela. Compare as duas variantes com:
+    for p in 1 0; do
+        gcc -O2 -DMEDIR_JITTER=1 -DPARTICIONAR_NUCLEOS=$p -o jitter$p main_principal.c -lpthread
+        sudo timeout 105 stdbuf -oL ./jitter$p | grep -a "Benchmark jitter"
+    done
+Cada linha resume só as suas BENCHMARK_JANELAS janelas. Acrescentando
+-DSIMULACAO_VIRTUAL=1 -DBENCHMARK_JANELAS=3500 (ver abaixo) a mesma
+comparação roda em tempo virtual, com uma linha cobrindo quase uma hora.
+
+Com -DSIMULACAO_VIRTUAL=1 o build do host vira uma simulação de eventos
+discretos: atrasos e esp_timer_get_time seguem um relógio virtual e cada
+execução de tarefa custa o caminho que o corpo tomou: custo_us quando ele
+imprime, CUSTO_BASE_US quando só leu um sensor inativo (ou o tempo medido,
+com -DSIMULACAO_CUSTO_MEDIDO=1). Os núcleos são escalonados como
+no FreeRTOS, por prioridade fixa com preempção, e as linhas "Tempo da ..."
+não são impressas. Uma hora de operação (SIMULACAO_DURACAO_S) roda em
+segundos e, com o custo modelado, a semente fixa (SIMULACAO_SEMENTE)
+torna o escalonamento reproduzível.
 */
 
+#ifndef ESP_PLATFORM
+#define _GNU_SOURCE // pthread_setaffinity_np e CPU_SET
+#endif
+
 // Bibliotecas necessárias para executar programa
 #include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef SIMULACAO_VIRTUAL
+#define SIMULACAO_VIRTUAL 0
+#endif
+#if defined(ESP_PLATFORM) && SIMULACAO_VIRTUAL
+#error "SIMULACAO_VIRTUAL só existe no build para o host"
+#endif
+
+// No relógio virtual o corpo da tarefa não consome tempo: o tempo medido
+// dentro dele seria sempre 0, então não é impresso
+#define IMPRIMIR_TEMPOS (!SIMULACAO_VIRTUAL)
+
+#ifdef ESP_PLATFORM
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/timers.h"
 #include "driver/gpio.h"
 #include "esp_timer.h"
 
+#define NUM_NUCLEOS portNUM_PROCESSORS
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Substitutos mínimos das APIs do ESP-IDF/FreeRTOS para rodar no host
+typedef void (*TaskFunction_t)(void *);
+typedef uint32_t TickType_t;
+
+#ifndef SIMULACAO_CUSTO_MEDIDO
+#define SIMULACAO_CUSTO_MEDIDO 0
+#endif
+#ifndef SIMULACAO_DURACAO_S
+#define SIMULACAO_DURACAO_S 3600 // Uma hora de operação do veículo
+#endif
+#ifndef SIMULACAO_SEMENTE
+#define SIMULACAO_SEMENTE 1
+#endif
+
+#define NUM_NUCLEOS 2
+#define GPIO_MODE_INPUT 0
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define esp_rom_gpio_pad_select_gpio(pin) ((void)(pin))
+#define gpio_set_direction(pin, modo) ((void)(pin), (void)(modo))
+
+static int64_t relogio_real_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+#if SIMULACAO_VIRTUAL
+static int64_t sim_relogio_us = 0; // Relógio virtual da simulação
+static void sim_atrasar(TickType_t ticks);
+// Sensores lidos pelo corpo em execução, para escolher o custo do caminho
+static __thread bool sim_leu_sensor;
+static __thread bool sim_sensor_acionado;
+#endif
+
+static int64_t esp_timer_get_time(void) {
+#if SIMULACAO_VIRTUAL
+    return sim_relogio_us;
+#else
+    return relogio_real_us();
+#endif
+}
+
+static void vTaskDelay(TickType_t ticks) {
+#if SIMULACAO_VIRTUAL
+    sim_atrasar(ticks);
+#else
+    usleep(ticks * 1000); // 1 tick = 1 ms no host
+#endif
+}
+
+// Sensores simulados: cada leitura tem 1% de chance de estar acionada
+static int gpio_get_level(int pin) {
+    (void)pin;
+    int nivel = (rand() % 100) == 0;
+#if SIMULACAO_VIRTUAL
+    sim_leu_sensor = true;
+    sim_sensor_acionado = sim_sensor_acionado || nivel;
+#endif
+    return nivel;
+}
+#endif
+
 // Definir os pinos dos sensores
 #define SENSOR_INJECAO_PIN 32  // GPIO para sensor de injeção eletrônica
 #define SENSOR_TEMPERATURA_PIN 33  // GPIO para sensor de temperatura do motor
@@ -35,6 +154,41 @@ Modificado em 19 de setembro de 2024
 
 #define AMOSTRAS 200 // Número de amostras para cálculo da média
 
+// Particionamento das tarefas entre os núcleos
+#ifndef PARTICIONAR_NUCLEOS
+#define PARTICIONAR_NUCLEOS 1 // 0 = o escalonador escolhe o núcleo livremente
+#endif
+#if NUM_NUCLEOS < 2
+// Alvos de um núcleo (CONFIG_FREERTOS_UNICORE, ESP32-S2/C3): não há o que
+// particionar, todas as tarefas são criadas sem afinidade
+#undef PARTICIONAR_NUCLEOS
+#define PARTICIONAR_NUCLEOS 0
+#endif
+#define NUCLEO_TEMPO_REAL 1 // APP_CPU: o PRO_CPU (0) já atende as tarefas do sistema
+#define NUCLEO_SUPORTE 0
+#define SEM_AFINIDADE -1
+#define LIMITE_UTILIZACAO 0.69f // Limite de Liu & Layland (ln 2) por núcleo
+
+#ifndef MEDIR_JITTER
+#define MEDIR_JITTER 0 // 1 = mede o período da injeção e mostra o jitter no display
+#endif
+#ifndef BENCHMARK_JANELAS
+#define BENCHMARK_JANELAS 100 // Janelas de 1 s por linha de resumo do benchmark
+#endif
+
+// Custo de pior caso por ativação usado no particionamento. São
+// orçamentos, não medições no alvo: cada linha impressa no caminho mais
+// longo da tarefa conta CUSTO_LINHA_US, supondo que a linha (~45 bytes)
+// cabe na FIFO de 128 bytes da UART do console e o printf só formata e
+// copia. Com a FIFO cheia a linha passa a custar a transmissão, cerca de
+// 45 x 87 μs a 115200 baud. Os amostradores não imprimem.
+#define CUSTO_LINHA_US 400
+#define CUSTO_AMOSTRADOR_US 50
+// Custo de uma ativação que só lê um sensor inativo e volta a dormir
+// (leitura do GPIO e o laço; também suposição, sem printf). Usado só pela
+// simulação, o particionamento considera sempre o pior caso.
+#define CUSTO_BASE_US 20
+
 static bool motor_ativo = false;
 static bool frenagem_ativo = false;
 static bool vida_ativa = false;
@@ -46,6 +200,103 @@ static int contagem_consumo = 0;
 static float velocidade_media = 0;
 static float consumo_media = 0;
 
+#if MEDIR_JITTER
+// Estatísticas do período da injeção na janela corrente, entre duas
+// atualizações do display. A injeção e o display rodam em núcleos
+// diferentes, então o acesso é protegido pela trava.
+typedef struct {
+    int64_t periodo_min;
+    int64_t periodo_max;
+    int64_t periodo_soma;
+    int ativacoes;
+} JanelaJitter;
+
+#define JANELA_JITTER_VAZIA ((JanelaJitter){ INT64_MAX, 0, 0, 0 })
+
+static JanelaJitter janela_jitter = JANELA_JITTER_VAZIA;
+
+#ifdef ESP_PLATFORM
+static portMUX_TYPE trava_jitter = portMUX_INITIALIZER_UNLOCKED;
+#define TRAVAR_JITTER() portENTER_CRITICAL(&trava_jitter)
+#define DESTRAVAR_JITTER() portEXIT_CRITICAL(&trava_jitter)
+#else
+static pthread_mutex_t trava_jitter = PTHREAD_MUTEX_INITIALIZER;
+#define TRAVAR_JITTER() pthread_mutex_lock(&trava_jitter)
+#define DESTRAVAR_JITTER() pthread_mutex_unlock(&trava_jitter)
+#endif
+
+void registrar_periodo_injecao(int64_t periodo) {
+    TRAVAR_JITTER();
+    if (periodo < janela_jitter.periodo_min) janela_jitter.periodo_min = periodo;
+    if (periodo > janela_jitter.periodo_max) janela_jitter.periodo_max = periodo;
+    janela_jitter.periodo_soma += periodo;
+    janela_jitter.ativacoes++;
+    DESTRAVAR_JITTER();
+}
+
+// Copia a janela corrente e começa uma nova
+JanelaJitter fechar_janela_jitter() {
+    TRAVAR_JITTER();
+    JanelaJitter janela = janela_jitter;
+    janela_jitter = JANELA_JITTER_VAZIA;
+    DESTRAVAR_JITTER();
+    return janela;
+}
+
+// Acumulado do benchmark, usado só pelo display. A primeira janela é
+// descartada porque inclui a partida das tarefas.
+static int64_t benchmark_jitter[BENCHMARK_JANELAS];
+static int benchmark_janelas = 0;
+static bool benchmark_aquecido = false;
+static int64_t benchmark_periodo_soma = 0;
+static long benchmark_ativacoes = 0;
+static int64_t benchmark_periodo_min = INT64_MAX;
+static int64_t benchmark_periodo_max = 0;
+
+// Acrescenta uma janela ao benchmark; a cada BENCHMARK_JANELAS janelas
+// imprime o resumo delas e recomeça a contagem
+void registrar_janela_benchmark(JanelaJitter janela) {
+    if (!benchmark_aquecido) {
+        benchmark_aquecido = true;
+        return;
+    }
+    if (janela.ativacoes == 0) return;
+
+    benchmark_jitter[benchmark_janelas++] = janela.periodo_max - janela.periodo_min;
+    benchmark_periodo_soma += janela.periodo_soma;
+    benchmark_ativacoes += janela.ativacoes;
+    if (janela.periodo_min < benchmark_periodo_min) benchmark_periodo_min = janela.periodo_min;
+    if (janela.periodo_max > benchmark_periodo_max) benchmark_periodo_max = janela.periodo_max;
+    if (benchmark_janelas < BENCHMARK_JANELAS) return;
+
+    // Ordenação por inserção do jitter das janelas
+    for (int i = 1; i < BENCHMARK_JANELAS; i++) {
+        int64_t atual = benchmark_jitter[i];
+        int j = i - 1;
+        while (j >= 0 && benchmark_jitter[j] > atual) {
+            benchmark_jitter[j + 1] = benchmark_jitter[j];
+            j--;
+        }
+        benchmark_jitter[j + 1] = atual;
+    }
+    printf("Benchmark jitter injeção (%s, %ld ativações): período médio %lld μs, "
+           "jitter por janela mediana %lld μs, p99 %lld μs, máximo %lld μs, "
+           "pico a pico total %lld μs\n",
+           PARTICIONAR_NUCLEOS ? "particionado" : "sem particionamento",
+           benchmark_ativacoes,
+           (long long)(benchmark_periodo_soma / benchmark_ativacoes),
+           (long long)benchmark_jitter[BENCHMARK_JANELAS / 2],
+           (long long)benchmark_jitter[(BENCHMARK_JANELAS * 99 + 99) / 100 - 1],
+           (long long)benchmark_jitter[BENCHMARK_JANELAS - 1],
+           (long long)(benchmark_periodo_max - benchmark_periodo_min));
+    benchmark_janelas = 0;
+    benchmark_periodo_soma = 0;
+    benchmark_ativacoes = 0;
+    benchmark_periodo_min = INT64_MAX;
+    benchmark_periodo_max = 0;
+}
+#endif
+
 // Configuração dos sensores
 void configurar_sensores() {
     // Configurar os pinos dos sensores como entradas
@@ -67,7 +318,21 @@ void configurar_sensores() {
 
 
 void monitoramento_injecao(void *pvParameter) {
+#if MEDIR_JITTER
+    bool primeira_ativacao = true;
+    int64_t ultima_ativacao = 0;
+#endif
     while (1) {
+#if MEDIR_JITTER
+        // Mede o intervalo entre ativações consecutivas
+        int64_t ativacao = esp_timer_get_time();
+        if (!primeira_ativacao) {
+            registrar_periodo_injecao(ativacao - ultima_ativacao);
+        }
+        primeira_ativacao = false;
+        ultima_ativacao = ativacao;
+#endif
+
         if (gpio_get_level(SENSOR_INJECAO_PIN)) {
 
             int64_t start_time = esp_timer_get_time();
@@ -76,7 +341,7 @@ void monitoramento_injecao(void *pvParameter) {
             printf("\033[32mInjeção eletrônica acionada!\033[0m\n");
 
             int64_t end_time = esp_timer_get_time();  // Captura o tempo após a ação
-            printf("\033[32mTempo da Injeção Eletrônica: %lld μs\033[0m\n", end_time - start_time);
+            if (IMPRIMIR_TEMPOS) printf("\033[32mTempo da Injeção Eletrônica: %lld μs\033[0m\n", (long long)(end_time - start_time));
 
             // Aguarda por 500 μs
             // while ((esp_timer_get_time() - start_time) < 500);
@@ -96,7 +361,7 @@ void monitoramento_temperatura(void *pvParameter) {
             printf("\033[31mTemperatura do motor acima do limite!\033[0m\n");
             // printf("Temperatura do motor acima do limite!\n");
             int64_t end_time = esp_timer_get_time();  // Captura o tempo de fim
-            printf("\033[31mTempo da Temperatura: %lld μs\033[0m\n", end_time - start_time);
+            if (IMPRIMIR_TEMPOS) printf("\033[31mTempo da Temperatura: %lld μs\033[0m\n", (long long)(end_time - start_time));
         }
         vTaskDelay(pdMS_TO_TICKS(TEMPO_TEMPERATURA_MS)); // Atraso de acordo com o deadline da temperatura
     }
@@ -111,7 +376,7 @@ void monitoramento_abs(void *pvParameter) {
             // printf("ABS acionado!\n");
             printf("\033[34mABS acionado!\033[0m\n");
             int64_t end_time = esp_timer_get_time();  // Captura o tempo de fim
-            printf("\033[34mTempo da ABS: %lld μs\033[0m\n", end_time - start_time);
+            if (IMPRIMIR_TEMPOS) printf("\033[34mTempo da ABS: %lld μs\033[0m\n", (long long)(end_time - start_time));
         }
         vTaskDelay(pdMS_TO_TICKS(TEMPO_ABS_MS)); // Atraso de acordo com o deadline do ABS
     }
@@ -126,7 +391,7 @@ void monitoramento_airbag(void *pvParameter) {
             // printf("Airbag acionado!\n");
             printf("\033[35mAirbag acionado!\033[0m\n");
             int64_t end_time = esp_timer_get_time();  // Captura o tempo de fim
-            printf("\033[35mTempo da Airbag: %lld μs\033[0m\n", end_time - start_time);
+            if (IMPRIMIR_TEMPOS) printf("\033[35mTempo da Airbag: %lld μs\033[0m\n", (long long)(end_time - start_time));
         }
         vTaskDelay(pdMS_TO_TICKS(TEMPO_AIRBAG_MS)); // Atraso de acordo com o deadline do airbag
     }
@@ -141,7 +406,7 @@ void monitoramento_cinto(void *pvParameter) {
             // printf("Cinto de segurança acionado!\n");
             printf("\033[36mCinto de segurança acionado!\033[0m\n");
             int64_t end_time = esp_timer_get_time();  // Captura o tempo de fim
-            printf("\033[36mTempo da cinto: %lld μs\033[0m\n", end_time - start_time);
+            if (IMPRIMIR_TEMPOS) printf("\033[36mTempo da cinto: %lld μs\033[0m\n", (long long)(end_time - start_time));
         }
         vTaskDelay(pdMS_TO_TICKS(TEMPO_CINTO_MS)); // Atraso de acordo com o deadline do cinto de segurança
     }
@@ -195,6 +460,16 @@ void atualizar_display(void *pvParameter) {
         printf("Vida: %s\n", vida_ativa ? "Ativo" : "Inativo");
         printf("Velocidade média: %.2f km/h\n", velocidade_media);
         printf("Consumo médio: %.2f L/100km\n", consumo_media);
+#if MEDIR_JITTER
+        JanelaJitter janela = fechar_janela_jitter();
+        if (janela.ativacoes > 0) {
+            printf("Período da injeção: médio %lld μs, jitter %lld μs (%d ativações)\n",
+                   (long long)(janela.periodo_soma / janela.ativacoes),
+                   (long long)(janela.periodo_max - janela.periodo_min),
+                   janela.ativacoes);
+        }
+        registrar_janela_benchmark(janela);
+#endif
 
         // Reseta o estado dos subsistemas para o próximo ciclo
         motor_ativo = false;
@@ -205,19 +480,400 @@ void atualizar_display(void *pvParameter) {
     }
 }
 
+// Descrição das tarefas usada pelo particionamento
+typedef struct {
+    TaskFunction_t funcao;
+    const char *nome;
+    int prioridade;
+    int periodo_ms;
+    int custo_us;     // Orçamento de pior caso por ativação (ver CUSTO_LINHA_US)
+    bool tempo_real;  // Tarefas críticas preferem o NUCLEO_TEMPO_REAL
+    int nucleo;       // Preenchido por particionar_tarefas()
+} Tarefa;
+
+static Tarefa tarefas[] = {
+    { monitoramento_injecao, "monitoramento_injecao", 6, TEMPO_INJECAO_MS, 2 * CUSTO_LINHA_US, true, SEM_AFINIDADE }, // Alta prioridade
+    { monitoramento_temperatura, "monitoramento_temperatura", 5, TEMPO_TEMPERATURA_MS, 2 * CUSTO_LINHA_US, true, SEM_AFINIDADE }, // Prioridade média-alta
+    { monitoramento_abs, "monitoramento_abs", 3, TEMPO_ABS_MS, 2 * CUSTO_LINHA_US, true, SEM_AFINIDADE }, // Prioridade média
+    { monitoramento_airbag, "monitoramento_airbag", 4, TEMPO_AIRBAG_MS, 2 * CUSTO_LINHA_US, true, SEM_AFINIDADE }, // Prioridade média-alta
+    { monitoramento_cinto, "monitoramento_cinto", 2, TEMPO_CINTO_MS, 2 * CUSTO_LINHA_US, false, SEM_AFINIDADE }, // Prioridade baixa
+    { atualizar_display, "atualizar_display", 1, 1000, 6 * CUSTO_LINHA_US, false, SEM_AFINIDADE }, // Prioridade mais baixa
+    { monitoramento_velocidade, "monitoramento_velocidade", 2, TEMPO_VELOCIDADE_MS, CUSTO_AMOSTRADOR_US, false, SEM_AFINIDADE }, // Prioridade baixa
+    { monitoramento_consumo, "monitoramento_consumo", 2, TEMPO_CONSUMO_MS, CUSTO_AMOSTRADOR_US, false, SEM_AFINIDADE }, // Prioridade baixa
+};
+
+#define NUM_TAREFAS (sizeof(tarefas) / sizeof(tarefas[0]))
+
+#if PARTICIONAR_NUCLEOS
+static float utilizacao(const Tarefa *t) {
+    return t->custo_us / (t->periodo_ms * 1000.0f);
+}
+
+// Particionamento first-fit decreasing sobre os núcleos, com capacidade
+// LIMITE_UTILIZACAO cada. As tarefas críticas são alocadas primeiro e,
+// dentro de cada classe, em ordem decrescente de utilização; cada uma vai
+// para o primeiro núcleo que ainda comporta sua carga, tentando antes o
+// núcleo da sua classe. Se alguma tarefa não couber em nenhum núcleo o
+// particionamento é inviável e todas ficam sem afinidade.
+void particionar_tarefas() {
+    float carga[NUM_NUCLEOS] = {0};
+    int ordem[NUM_TAREFAS];
+
+    for (int i = 0; i < (int)NUM_TAREFAS; i++) {
+        ordem[i] = i;
+    }
+    // Ordenação por inserção: críticas primeiro, depois utilização decrescente
+    for (int i = 1; i < (int)NUM_TAREFAS; i++) {
+        Tarefa *atual = &tarefas[ordem[i]];
+        int j = i - 1;
+        while (j >= 0) {
+            Tarefa *anterior = &tarefas[ordem[j]];
+            bool trocar = (anterior->tempo_real != atual->tempo_real)
+                ? atual->tempo_real
+                : utilizacao(anterior) < utilizacao(atual);
+            if (!trocar) break;
+            ordem[j + 1] = ordem[j];
+            j--;
+        }
+        ordem[j + 1] = (int)(atual - tarefas);
+    }
+
+    for (int i = 0; i < (int)NUM_TAREFAS; i++) {
+        Tarefa *t = &tarefas[ordem[i]];
+        float u = utilizacao(t);
+        int preferido = t->tempo_real ? NUCLEO_TEMPO_REAL : NUCLEO_SUPORTE;
+
+        t->nucleo = SEM_AFINIDADE;
+        for (int k = 0; k < NUM_NUCLEOS; k++) {
+            // Tenta o núcleo preferido e depois os demais em ordem
+            int n = (k == 0) ? preferido : (k <= preferido ? k - 1 : k);
+            if (carga[n] + u <= LIMITE_UTILIZACAO) {
+                t->nucleo = n;
+                carga[n] += u;
+                break;
+            }
+        }
+
+        if (t->nucleo == SEM_AFINIDADE) {
+            printf("Aviso: %s não cabe em nenhum núcleo, tarefas criadas sem afinidade\n", t->nome);
+            for (int j = 0; j < (int)NUM_TAREFAS; j++) {
+                tarefas[j].nucleo = SEM_AFINIDADE;
+            }
+            return;
+        }
+    }
+
+    for (int n = 0; n < NUM_NUCLEOS; n++) {
+        printf("Núcleo %d: utilização %.1f%%\n", n, carga[n] * 100.0f);
+    }
+}
+#endif
+
+#if !defined(ESP_PLATFORM) && SIMULACAO_VIRTUAL
+// Simulação de eventos discretos. Cada tarefa continua sendo uma thread,
+// mas só uma executa por vez. Cada núcleo executa o trabalho pronto de
+// maior prioridade, como no FreeRTOS: uma liberação de prioridade maior
+// preempta o trabalho em curso, que continua depois com o custo que
+// falta. O corpo da tarefa roda de uma vez no instante em que ela ganha o
+// núcleo pela primeira vez; a partir daí só o custo dela é consumido.
+// Prioridades iguais não têm fatiamento de tempo: vale a ordem de
+// liberação. Tarefas sem afinidade são atribuídas na liberação ao núcleo
+// ocioso, ou ao que executa a tarefa de menor prioridade, e não migram.
+typedef struct {
+    int64_t tempo_us;   // Instante da liberação
+    uint64_t sequencia; // Desempate estável, garante reprodutibilidade
+    int tarefa;
+} EventoSimulacao;
+
+// Estado da ativação corrente de cada tarefa
+typedef struct {
+    bool pronta;          // Liberada e ainda não concluída
+    bool iniciada;        // O corpo já executou, resta consumir o custo
+    int nucleo;
+    uint64_t ordem;       // Ordem de liberação, desempata prioridades iguais
+    int64_t liberacao_us;
+    int64_t restante_us;
+    TickType_t atraso;    // Pedido pelo vTaskDelay ao fim do corpo
+} TrabalhoSimulacao;
+
+// Cada tarefa tem no máximo uma liberação pendente
+static EventoSimulacao sim_fila[NUM_TAREFAS];
+static int sim_tamanho_fila = 0;
+static uint64_t sim_sequencia = 0;
+
+static TrabalhoSimulacao sim_trabalhos[NUM_TAREFAS];
+static int sim_tarefa_atual = -1; // -1 = nenhum corpo de tarefa executando
+static int64_t sim_inicio_real_us;
+static int64_t sim_ocupacao_us[NUM_NUCLEOS];
+static long sim_ativacoes[NUM_TAREFAS];
+static int64_t sim_resposta_max_us[NUM_TAREFAS];
+
+static pthread_mutex_t sim_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sim_cond_escalonador = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t sim_cond_tarefa[NUM_TAREFAS];
+static __thread int sim_id = -1;
+
+static bool sim_antes(const EventoSimulacao *a, const EventoSimulacao *b) {
+    if (a->tempo_us != b->tempo_us) return a->tempo_us < b->tempo_us;
+    return a->sequencia < b->sequencia;
+}
+
+static void sim_inserir(int64_t tempo_us, int tarefa) {
+    int i = sim_tamanho_fila++;
+    sim_fila[i] = (EventoSimulacao){ tempo_us, sim_sequencia++, tarefa };
+    while (i > 0 && sim_antes(&sim_fila[i], &sim_fila[(i - 1) / 2])) {
+        EventoSimulacao tmp = sim_fila[i];
+        sim_fila[i] = sim_fila[(i - 1) / 2];
+        sim_fila[(i - 1) / 2] = tmp;
+        i = (i - 1) / 2;
+    }
+}
+
+static EventoSimulacao sim_remover(void) {
+    EventoSimulacao topo = sim_fila[0];
+    sim_fila[0] = sim_fila[--sim_tamanho_fila];
+    int i = 0;
+    while (1) {
+        int menor = i;
+        int esq = 2 * i + 1;
+        int dir = 2 * i + 2;
+        if (esq < sim_tamanho_fila && sim_antes(&sim_fila[esq], &sim_fila[menor])) menor = esq;
+        if (dir < sim_tamanho_fila && sim_antes(&sim_fila[dir], &sim_fila[menor])) menor = dir;
+        if (menor == i) break;
+        EventoSimulacao tmp = sim_fila[i];
+        sim_fila[i] = sim_fila[menor];
+        sim_fila[menor] = tmp;
+        i = menor;
+    }
+    return topo;
+}
+
+// Bloqueia a thread chamadora até o escalonador despachá-la (sim_mutex travado)
+static void sim_aguardar_vez(void) {
+    while (sim_tarefa_atual != sim_id) {
+        pthread_cond_wait(&sim_cond_tarefa[sim_id], &sim_mutex);
+    }
+    sim_inicio_real_us = relogio_real_us();
+    sim_leu_sensor = false;
+    sim_sensor_acionado = false;
+}
+
+// Substitui o vTaskDelay: registra o custo do corpo que terminou e o
+// atraso pedido, e devolve o controle ao escalonador
+static void sim_atrasar(TickType_t ticks) {
+    pthread_mutex_lock(&sim_mutex);
+
+#if SIMULACAO_CUSTO_MEDIDO
+    sim_trabalhos[sim_id].restante_us = relogio_real_us() - sim_inicio_real_us;
+#else
+    // Sensor lido e inativo: o corpo não imprimiu nada. Nos demais casos
+    // (sensor acionado, display, amostradores) vale o orçamento da tarefa.
+    bool caminho_curto = sim_leu_sensor && !sim_sensor_acionado;
+    sim_trabalhos[sim_id].restante_us = caminho_curto ? CUSTO_BASE_US : tarefas[sim_id].custo_us;
+#endif
+    sim_trabalhos[sim_id].atraso = ticks;
+
+    sim_tarefa_atual = -1;
+    pthread_cond_signal(&sim_cond_escalonador);
+    sim_aguardar_vez();
+    pthread_mutex_unlock(&sim_mutex);
+}
+
+// Trabalho pronto de maior prioridade no núcleo, ou -1 se ele está ocioso
+static int sim_em_execucao(int nucleo) {
+    int escolhida = -1;
+    for (int i = 0; i < (int)NUM_TAREFAS; i++) {
+        TrabalhoSimulacao *w = &sim_trabalhos[i];
+        if (!w->pronta || w->nucleo != nucleo) continue;
+        if (escolhida == -1
+            || tarefas[i].prioridade > tarefas[escolhida].prioridade
+            || (tarefas[i].prioridade == tarefas[escolhida].prioridade
+                && w->ordem < sim_trabalhos[escolhida].ordem)) {
+            escolhida = i;
+        }
+    }
+    return escolhida;
+}
+
+static int sim_escolher_nucleo(int tarefa) {
+    if (tarefas[tarefa].nucleo != SEM_AFINIDADE) {
+        return tarefas[tarefa].nucleo;
+    }
+    int nucleo = 0;
+    int menor_prioridade = 0;
+    for (int n = 0; n < NUM_NUCLEOS; n++) {
+        int atual = sim_em_execucao(n);
+        int prioridade = (atual == -1) ? -1 : tarefas[atual].prioridade;
+        if (n == 0 || prioridade < menor_prioridade) {
+            nucleo = n;
+            menor_prioridade = prioridade;
+        }
+    }
+    return nucleo;
+}
+
+// Executa o corpo da tarefa até o próximo vTaskDelay (sim_mutex travado)
+static void sim_executar_corpo(int tarefa) {
+    sim_tarefa_atual = tarefa;
+    pthread_cond_signal(&sim_cond_tarefa[tarefa]);
+    while (sim_tarefa_atual != -1) {
+        pthread_cond_wait(&sim_cond_escalonador, &sim_mutex);
+    }
+    sim_trabalhos[tarefa].iniciada = true;
+}
+
+// Laço do escalonador: avança o relógio virtual até a próxima liberação
+// ou conclusão de trabalho
+void simular(int64_t duracao_us) {
+    int64_t inicio_real = relogio_real_us();
+
+    pthread_mutex_lock(&sim_mutex);
+    while (1) {
+        int64_t proximo = (sim_tamanho_fila > 0) ? sim_fila[0].tempo_us : INT64_MAX;
+        for (int n = 0; n < NUM_NUCLEOS; n++) {
+            int t = sim_em_execucao(n);
+            if (t == -1) continue;
+            if (!sim_trabalhos[t].iniciada) {
+                sim_executar_corpo(t);
+            }
+            if (sim_relogio_us + sim_trabalhos[t].restante_us < proximo) {
+                proximo = sim_relogio_us + sim_trabalhos[t].restante_us;
+            }
+        }
+        if (proximo == INT64_MAX || proximo > duracao_us) {
+            break;
+        }
+
+        // Consome o custo dos trabalhos em execução até o próximo instante
+        int64_t passo = proximo - sim_relogio_us;
+        for (int n = 0; n < NUM_NUCLEOS; n++) {
+            int t = sim_em_execucao(n);
+            if (t == -1) continue;
+            sim_trabalhos[t].restante_us -= passo;
+            sim_ocupacao_us[n] += passo;
+        }
+        sim_relogio_us = proximo;
+
+        // Conclusões: a próxima liberação vem depois do atraso pedido
+        for (int i = 0; i < (int)NUM_TAREFAS; i++) {
+            TrabalhoSimulacao *w = &sim_trabalhos[i];
+            if (!w->pronta || !w->iniciada || w->restante_us > 0) continue;
+            w->pronta = false;
+            if (sim_relogio_us - w->liberacao_us > sim_resposta_max_us[i]) {
+                sim_resposta_max_us[i] = sim_relogio_us - w->liberacao_us;
+            }
+            sim_ativacoes[i]++;
+            sim_inserir(sim_relogio_us + (int64_t)w->atraso * 1000, i);
+        }
+
+        // Liberações
+        while (sim_tamanho_fila > 0 && sim_fila[0].tempo_us == sim_relogio_us) {
+            EventoSimulacao e = sim_remover();
+            TrabalhoSimulacao *w = &sim_trabalhos[e.tarefa];
+            // O núcleo é escolhido antes de a tarefa contar como pronta,
+            // senão ela ocuparia o núcleo da ativação anterior na escolha
+            w->nucleo = sim_escolher_nucleo(e.tarefa);
+            w->pronta = true;
+            w->iniciada = false;
+            w->ordem = e.sequencia;
+            w->liberacao_us = sim_relogio_us;
+        }
+    }
+
+    int64_t duracao_real = relogio_real_us() - inicio_real;
+    printf("Simulação (prioridade fixa preemptiva): %.1f s virtuais em %.2f s reais\n",
+           sim_relogio_us / 1e6, duracao_real / 1e6);
+    for (int i = 0; i < (int)NUM_TAREFAS; i++) {
+        printf("%s: %ld ativações, resposta máxima %lld μs\n",
+               tarefas[i].nome, sim_ativacoes[i], (long long)sim_resposta_max_us[i]);
+    }
+    for (int n = 0; n < NUM_NUCLEOS; n++) {
+        printf("Núcleo %d: ocupação %.2f%%\n", n, 100.0 * sim_ocupacao_us[n] / sim_relogio_us);
+    }
+    pthread_mutex_unlock(&sim_mutex);
+}
+#endif
+
+#ifndef ESP_PLATFORM
+// Ponto de entrada das threads no host: aplica afinidade e SCHED_FIFO
+// antes de executar o corpo da tarefa
+static void *executar_tarefa(void *arg) {
+    Tarefa *t = (Tarefa *)arg;
+
+#if SIMULACAO_VIRTUAL
+    // Na simulação os núcleos são modelados, não há afinidade real
+    sim_id = (int)(t - tarefas);
+    pthread_mutex_lock(&sim_mutex);
+    sim_aguardar_vez();
+    pthread_mutex_unlock(&sim_mutex);
+#else
+    if (t->nucleo != SEM_AFINIDADE) {
+        cpu_set_t nucleos;
+        CPU_ZERO(&nucleos);
+        CPU_SET(t->nucleo, &nucleos);
+        int erro = pthread_setaffinity_np(pthread_self(), sizeof(nucleos), &nucleos);
+        if (erro != 0) {
+            printf("Aviso: afinidade de %s: %s\n", t->nome, strerror(erro));
+        }
+    }
+
+    struct sched_param param = { .sched_priority = sched_get_priority_min(SCHED_FIFO) + t->prioridade };
+    int erro = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (erro != 0) {
+        printf("Aviso: SCHED_FIFO para %s: %s\n", t->nome, strerror(erro));
+    }
+#endif
+
+    t->funcao(NULL);
+    return NULL;
+}
+#endif
+
+void criar_tarefa(Tarefa *t) {
+#ifdef ESP_PLATFORM
+    BaseType_t nucleo = (t->nucleo == SEM_AFINIDADE) ? tskNO_AFFINITY : t->nucleo;
+    xTaskCreatePinnedToCore(t->funcao, t->nome, 2048, NULL, t->prioridade, NULL, nucleo);
+#else
+#if SIMULACAO_VIRTUAL
+    // Primeira liberação de todas as tarefas no instante zero
+    pthread_mutex_lock(&sim_mutex);
+    pthread_cond_init(&sim_cond_tarefa[t - tarefas], NULL);
+    sim_inserir(0, (int)(t - tarefas));
+    pthread_mutex_unlock(&sim_mutex);
+#endif
+    pthread_t thread;
+    pthread_create(&thread, NULL, executar_tarefa, t);
+    pthread_detach(thread);
+#endif
+}
+
 // Função principal
 void app_main() {
 
     // Configuração dos sensores
     configurar_sensores();
 
+#if PARTICIONAR_NUCLEOS
+    particionar_tarefas();
+#endif
+
     // Criação das tarefas de monitoramento dos sensores com prioridades baseadas nos deadlines
-    xTaskCreate(monitoramento_injecao, "monitoramento_injecao", 2048, NULL, 6, NULL); // Alta prioridade
-    xTaskCreate(monitoramento_temperatura, "monitoramento_temperatura", 2048, NULL, 5, NULL); // Prioridade média-alta
-    xTaskCreate(monitoramento_abs, "monitoramento_abs", 2048, NULL, 3, NULL); // Prioridade média
-    xTaskCreate(monitoramento_airbag, "monitoramento_airbag", 2048, NULL, 4, NULL); // Prioridade média-alta
-    xTaskCreate(monitoramento_cinto, "monitoramento_cinto", 2048, NULL, 2, NULL); // Prioridade baixa
-    xTaskCreate(atualizar_display, "atualizar_display", 2048, NULL, 1, NULL); // Prioridade mais baixa
-    xTaskCreate(monitoramento_velocidade, "monitoramento_velocidade", 2048, NULL, 2, NULL); // Prioridade baixa
-    xTaskCreate(monitoramento_consumo, "monitoramento_consumo", 2048, NULL, 2, NULL); // Prioridade baixa
+    for (int i = 0; i < (int)NUM_TAREFAS; i++) {
+        printf("%s -> núcleo %d\n", tarefas[i].nome, tarefas[i].nucleo);
+        criar_tarefa(&tarefas[i]);
+    }
+}
+
+#ifndef ESP_PLATFORM
+int main() {
+#if SIMULACAO_VIRTUAL
+    srand(SIMULACAO_SEMENTE);
+    app_main();
+    simular((int64_t)SIMULACAO_DURACAO_S * 1000000);
+    return 0; // Encerra as threads, que estão todas bloqueadas
+#else
+    app_main();
+    pthread_exit(NULL); // Mantém o processo vivo enquanto as tarefas executam
+#endif
 }
+#endif